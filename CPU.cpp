@@ -1,5 +1,20 @@
 #include "CPU.h"
+#include <cstring>
+#include <cstddef>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
+// The AVX2 kernel is compiled with a target attribute and picked at run time,
+// so the binary stays runnable on SSE2-only CPUs. CPU_VISUALIZER_NO_AVX2
+// disables it (the tests use this to exercise the SSE2 path).
+#if defined(__SSE2__) && defined(__GNUC__) && !defined(CPU_VISUALIZER_NO_AVX2)
+#define CPU_AVX2_DISPATCH 1
+#endif
 
 using namespace std;
 
@@ -8,6 +23,9 @@ CPU::CPU() {
                  {"RSI",0},{"RDI",0},{"RSP",0},{"RBP",0},{"RIP",0}};
     flags = {{"ZF",false},{"CF",false},{"SF",false},{"OF",false}};
     for(int i=0;i<256;i++) memory[i]=0;
+    memset(vregisters, 0, sizeof(vregisters));
+    scalarOps = 0;
+    vectorOps = 0;
 
     // set a reasonable initial stack pointer inside our small memory
     registers["RSP"] = 240; // top of stack near end of 256 bytes
@@ -40,6 +58,32 @@ void CPU::setMemory(size_t addr,uint8_t value) {
     memory[addr] = value;
 }
 
+VectorRegister CPU::getVectorRegister(const string &name) const {
+    size_t width;
+    VectorRegister r{};
+    size_t idx = vectorIndex(name, width);
+    memcpy(r.bytes, vregisters[idx].bytes, width);
+    return r;
+}
+
+size_t CPU::vectorIndex(const string &name, size_t &width) const {
+    if (name.size() == 4 && (name.rfind("XMM",0) == 0 || name.rfind("YMM",0) == 0)
+        && name[3] >= '0' && name[3] <= '7') {
+        width = (name[0] == 'Y') ? 32 : 16;
+        return name[3] - '0';
+    }
+    throw out_of_range("Unknown vector register: " + name);
+}
+
+// "[RSI]" or "[0x40]" -> address, checked so that width bytes fit in memory
+size_t CPU::memOperand(const string &s, size_t width) {
+    if (s.size() < 3 || s.front() != '[' || s.back() != ']') throw out_of_range("Invalid memory operand: " + s);
+    string inner = s.substr(1, s.size() - 2);
+    uint64_t addr = (registers.find(inner)!=registers.end())?registers[inner]:strToValue(inner);
+    if (addr > 256 - width) throw out_of_range("Memory out of range");
+    return addr;
+}
+
 // ---------- basic instructions ----------
 void CPU::MOV(const string &dest,const string &src){
     if (registers.find(dest) == registers.end()) throw out_of_range("Invalid MOV dest: " + dest);
@@ -176,34 +220,233 @@ void CPU::XOR(const string &reg1,const string &reg2){
     flags["OF"] = false;
 }
 
+// ---------- vector ----------
+namespace {
+
+// Guest lanes and snapshot fields are little-endian on every host
+uint64_t loadLE(const uint8_t *p, size_t n){
+    uint64_t v = 0;
+    for (size_t i = n; i-- > 0;) v = (v << 8) | p[i];
+    return v;
+}
+
+void storeLE(uint8_t *p, uint64_t v, size_t n){
+    for (size_t i = 0; i < n; ++i) p[i] = static_cast<uint8_t>(v >> (8*i));
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+uint64_t toLE(uint64_t v){ return __builtin_bswap64(v); }
+uint32_t toLE(uint32_t v){ return __builtin_bswap32(v); }
+#else
+uint64_t toLE(uint64_t v){ return v; }
+uint32_t toLE(uint32_t v){ return v; }
+#endif
+
+enum VecKernel { K_ADD32, K_ADD64, K_SUB32, K_SUB64, K_AND, K_OR, K_XOR, K_CMPEQ32, K_CMPEQ64 };
+
+#if defined(CPU_AVX2_DISPATCH)
+__attribute__((target("avx2")))
+void vecKernelAVX2(VecKernel k, uint8_t *dst, const uint8_t *src){
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    __m256i r;
+    switch(k){
+    case K_ADD32: r = _mm256_add_epi32(a,b); break;
+    case K_ADD64: r = _mm256_add_epi64(a,b); break;
+    case K_SUB32: r = _mm256_sub_epi32(a,b); break;
+    case K_SUB64: r = _mm256_sub_epi64(a,b); break;
+    case K_AND: r = _mm256_and_si256(a,b); break;
+    case K_OR: r = _mm256_or_si256(a,b); break;
+    case K_XOR: r = _mm256_xor_si256(a,b); break;
+    case K_CMPEQ32: r = _mm256_cmpeq_epi32(a,b); break;
+    case K_CMPEQ64: r = _mm256_cmpeq_epi64(a,b); break;
+    default: r = a; break;
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), r);
+}
+
+bool hostHasAVX2(){
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+}
+#endif
+
+// dst = dst op src over width bytes (16 or 32). Uses AVX2 for full YMM
+// registers when the host has it, SSE2 per 128-bit half, and plain lane
+// loops elsewhere.
+void vecKernel(VecKernel k, uint8_t *dst, const uint8_t *src, size_t width){
+#if defined(CPU_AVX2_DISPATCH)
+    if (width == 32 && hostHasAVX2()) {
+        vecKernelAVX2(k, dst, src);
+        return;
+    }
+#endif
+#if defined(__SSE2__)
+    for (size_t off = 0; off < width; off += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + off));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + off));
+        __m128i r;
+        switch(k){
+        case K_ADD32: r = _mm_add_epi32(a,b); break;
+        case K_ADD64: r = _mm_add_epi64(a,b); break;
+        case K_SUB32: r = _mm_sub_epi32(a,b); break;
+        case K_SUB64: r = _mm_sub_epi64(a,b); break;
+        case K_AND: r = _mm_and_si128(a,b); break;
+        case K_OR: r = _mm_or_si128(a,b); break;
+        case K_XOR: r = _mm_xor_si128(a,b); break;
+        case K_CMPEQ32: r = _mm_cmpeq_epi32(a,b); break;
+        case K_CMPEQ64:
+#if defined(__SSE4_1__)
+            r = _mm_cmpeq_epi64(a,b);
+#else
+            // both 32-bit halves must match: AND each dword mask with its neighbour
+            r = _mm_cmpeq_epi32(a,b);
+            r = _mm_and_si128(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(2,3,0,1)));
+#endif
+            break;
+        default: r = a; break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + off), r);
+    }
+#else
+    bool lanes64 = (k == K_ADD64 || k == K_SUB64 || k == K_CMPEQ64 ||
+                    k == K_AND || k == K_OR || k == K_XOR);
+    if (lanes64) {
+        for (size_t off = 0; off < width; off += 8) {
+            uint64_t a = loadLE(dst + off, 8), b = loadLE(src + off, 8), r;
+            switch(k){
+            case K_ADD64: r = a + b; break;
+            case K_SUB64: r = a - b; break;
+            case K_AND: r = a & b; break;
+            case K_OR: r = a | b; break;
+            case K_XOR: r = a ^ b; break;
+            default: r = (a == b) ? ~0ULL : 0; break;
+            }
+            storeLE(dst + off, r, 8);
+        }
+    } else {
+        for (size_t off = 0; off < width; off += 4) {
+            uint32_t a = static_cast<uint32_t>(loadLE(dst + off, 4));
+            uint32_t b = static_cast<uint32_t>(loadLE(src + off, 4));
+            uint32_t r;
+            switch(k){
+            case K_ADD32: r = a + b; break;
+            case K_SUB32: r = a - b; break;
+            default: r = (a == b) ? ~0U : 0; break;
+            }
+            storeLE(dst + off, r, 4);
+        }
+    }
+#endif
+}
+
+void vecBroadcast(uint8_t *dst, uint64_t value, size_t lane, size_t width){
+    for (size_t off = 0; off < width; off += lane) storeLE(dst + off, value, lane);
+}
+
+}
+
+#define VEC_BINARY(NAME, KERNEL) \
+void CPU::NAME(const string &dest,const string &src){ \
+    size_t dw, sw; \
+    size_t d = vectorIndex(dest, dw); \
+    size_t s = vectorIndex(src, sw); \
+    if (dw != sw) throw out_of_range("Mismatched vector widths: " + dest + ", " + src); \
+    vecKernel(KERNEL, vregisters[d].bytes, vregisters[s].bytes, dw); \
+    if (dw == 16) memset(vregisters[d].bytes + 16, 0, 16); \
+}
+
+VEC_BINARY(VPADDD, K_ADD32)
+VEC_BINARY(VPADDQ, K_ADD64)
+VEC_BINARY(VPSUBD, K_SUB32)
+VEC_BINARY(VPSUBQ, K_SUB64)
+VEC_BINARY(VPAND, K_AND)
+VEC_BINARY(VPOR, K_OR)
+VEC_BINARY(VPXOR, K_XOR)
+VEC_BINARY(VPCMPEQD, K_CMPEQ32)
+VEC_BINARY(VPCMPEQQ, K_CMPEQ64)
+
+#undef VEC_BINARY
+
+void CPU::VPBROADCASTD(const string &dest,const string &src){
+    size_t width;
+    size_t d = vectorIndex(dest, width);
+    uint64_t value = (registers.find(src)!=registers.end())?registers[src]:strToValue(src);
+    memset(vregisters[d].bytes, 0, 32);
+    vecBroadcast(vregisters[d].bytes, value, 4, width);
+}
+
+void CPU::VPBROADCASTQ(const string &dest,const string &src){
+    size_t width;
+    size_t d = vectorIndex(dest, width);
+    uint64_t value = (registers.find(src)!=registers.end())?registers[src]:strToValue(src);
+    memset(vregisters[d].bytes, 0, 32);
+    vecBroadcast(vregisters[d].bytes, value, 8, width);
+}
+
+void CPU::VMOVDQU(const string &dest,const string &src){
+    size_t width;
+    if (!dest.empty() && dest.front() == '[') {
+        size_t s = vectorIndex(src, width);
+        memcpy(memory + memOperand(dest, width), vregisters[s].bytes, width);
+        return;
+    }
+    size_t d = vectorIndex(dest, width);
+    uint8_t tmp[32] = {0};
+    if (!src.empty() && src.front() == '[') {
+        memcpy(tmp, memory + memOperand(src, width), width);
+    } else {
+        size_t sw;
+        size_t s = vectorIndex(src, sw);
+        if (sw != width) throw out_of_range("Mismatched vector widths: " + dest + ", " + src);
+        memcpy(tmp, vregisters[s].bytes, width);
+    }
+    memcpy(vregisters[d].bytes, tmp, 32);
+}
+
 // ---------- control flow ----------
 void CPU::JMP(size_t addr,size_t &pc){ pc = addr; }
 void CPU::JE(size_t addr,size_t &pc){ if(flags["ZF"]) pc = addr; else pc++; }
 void CPU::JNE(size_t addr,size_t &pc){ if(!flags["ZF"]) pc = addr; else pc++; }
 
 void CPU::execute(const Instruction &instr,size_t &pc){
-    if(instr.op == "MOV") { MOV(instr.arg1, instr.arg2); pc++; }
-    else if(instr.op == "ADD") { ADD(instr.arg1, instr.arg2); pc++; }
-    else if(instr.op == "SUB") { SUB(instr.arg1, instr.arg2); pc++; }
-    else if(instr.op == "CMP") { CMP(instr.arg1, instr.arg2); pc++; }
-    else if(instr.op == "MUL") { MUL(instr.arg1, instr.arg2); pc++; }
-    else if(instr.op == "DIV") { DIV(instr.arg1); pc++; }
-    else if(instr.op == "INC") { INC(instr.arg1); pc++; }
-    else if(instr.op == "DEC") { DEC(instr.arg1); pc++; }
-    else if(instr.op == "AND") { AND(instr.arg1, instr.arg2); pc++; }
-    else if(instr.op == "OR")  { OR(instr.arg1, instr.arg2); pc++; }
-    else if(instr.op == "XOR") { XOR(instr.arg1, instr.arg2); pc++; }
+    if(instr.op == "MOV") { MOV(instr.arg1, instr.arg2); scalarOps++; pc++; }
+    else if(instr.op == "ADD") { ADD(instr.arg1, instr.arg2); scalarOps++; pc++; }
+    else if(instr.op == "SUB") { SUB(instr.arg1, instr.arg2); scalarOps++; pc++; }
+    else if(instr.op == "CMP") { CMP(instr.arg1, instr.arg2); scalarOps++; pc++; }
+    else if(instr.op == "MUL") { MUL(instr.arg1, instr.arg2); scalarOps++; pc++; }
+    else if(instr.op == "DIV") { DIV(instr.arg1); scalarOps++; pc++; }
+    else if(instr.op == "INC") { INC(instr.arg1); scalarOps++; pc++; }
+    else if(instr.op == "DEC") { DEC(instr.arg1); scalarOps++; pc++; }
+    else if(instr.op == "AND") { AND(instr.arg1, instr.arg2); scalarOps++; pc++; }
+    else if(instr.op == "OR")  { OR(instr.arg1, instr.arg2); scalarOps++; pc++; }
+    else if(instr.op == "XOR") { XOR(instr.arg1, instr.arg2); scalarOps++; pc++; }
+    else if(instr.op == "VPADDD") { VPADDD(instr.arg1, instr.arg2); vectorOps++; pc++; }
+    else if(instr.op == "VPADDQ") { VPADDQ(instr.arg1, instr.arg2); vectorOps++; pc++; }
+    else if(instr.op == "VPSUBD") { VPSUBD(instr.arg1, instr.arg2); vectorOps++; pc++; }
+    else if(instr.op == "VPSUBQ") { VPSUBQ(instr.arg1, instr.arg2); vectorOps++; pc++; }
+    else if(instr.op == "VPAND") { VPAND(instr.arg1, instr.arg2); vectorOps++; pc++; }
+    else if(instr.op == "VPOR")  { VPOR(instr.arg1, instr.arg2); vectorOps++; pc++; }
+    else if(instr.op == "VPXOR") { VPXOR(instr.arg1, instr.arg2); vectorOps++; pc++; }
+    else if(instr.op == "VPCMPEQD") { VPCMPEQD(instr.arg1, instr.arg2); vectorOps++; pc++; }
+    else if(instr.op == "VPCMPEQQ") { VPCMPEQQ(instr.arg1, instr.arg2); vectorOps++; pc++; }
+    else if(instr.op == "VPBROADCASTD") { VPBROADCASTD(instr.arg1, instr.arg2); vectorOps++; pc++; }
+    else if(instr.op == "VPBROADCASTQ") { VPBROADCASTQ(instr.arg1, instr.arg2); vectorOps++; pc++; }
+    else if(instr.op == "VMOVDQU") { VMOVDQU(instr.arg1, instr.arg2); vectorOps++; pc++; }
     else if(instr.op == "JMP") {
         if(labelMap.find(instr.arg1)==labelMap.end()) throw runtime_error("Unknown label: " + instr.arg1);
         JMP(labelMap[instr.arg1], pc);
+        scalarOps++;
     }
     else if(instr.op == "JE") {
         if(labelMap.find(instr.arg1)==labelMap.end()) throw runtime_error("Unknown label: " + instr.arg1);
         JE(labelMap[instr.arg1], pc);
+        scalarOps++;
     }
     else if(instr.op == "JNE") {
         if(labelMap.find(instr.arg1)==labelMap.end()) throw runtime_error("Unknown label: " + instr.arg1);
         JNE(labelMap[instr.arg1], pc);
+        scalarOps++;
     }
     else {
         // unknown op -> just advance
@@ -218,6 +461,177 @@ void CPU::buildLabelMap(const vector<Instruction> &program){
     }
 }
 
+// ---------- snapshots ----------
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'C','P','U','S','N','A','P','\0'};
+const uint32_t SNAPSHOT_VERSION = 2;
+const char *SNAPSHOT_REGS[9] = {"RAX","RBX","RCX","RDX","RSI","RDI","RSP","RBP","RIP"};
+const char *SNAPSHOT_FLAGS[4] = {"ZF","CF","SF","OF"};
+
+// On-disk layout, mapped directly; the static_asserts below pin every offset.
+// Multi-byte fields are stored little-endian (see toLE).
+// The checksum covers pc through the last payload field (reserved2 included).
+// v2 appended the vector register bank and op counters; a v1 file is exactly
+// the v2 prefix up to vregisters, padded to 384 bytes.
+struct SnapshotImage {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t programHash;
+    uint64_t checksum;
+    uint64_t pc;
+    uint64_t cycleCount;
+    uint64_t registers[9];
+    uint8_t flags[4];
+    uint8_t memory[256];
+    uint8_t vregisters[8][32];
+    uint32_t reserved2;     // keeps scalarOps 8-byte aligned; always 0
+    uint64_t scalarOps;
+    uint64_t vectorOps;
+};
+
+static_assert(offsetof(SnapshotImage, pc) == 32, "snapshot layout");
+static_assert(offsetof(SnapshotImage, registers) == 48, "snapshot layout");
+static_assert(offsetof(SnapshotImage, flags) == 120, "snapshot layout");
+static_assert(offsetof(SnapshotImage, memory) == 124, "snapshot layout");
+static_assert(offsetof(SnapshotImage, vregisters) == 380, "snapshot layout");
+static_assert(offsetof(SnapshotImage, reserved2) == 636, "snapshot layout");
+static_assert(offsetof(SnapshotImage, scalarOps) == 640, "snapshot layout");
+static_assert(sizeof(SnapshotImage) == 656, "snapshot layout");
+
+const size_t CHECKSUM_BEGIN = offsetof(SnapshotImage, pc);
+const size_t CHECKSUM_END = sizeof(SnapshotImage);
+const size_t V1_CHECKSUM_END = offsetof(SnapshotImage, vregisters);
+const size_t V1_SIZE = 384;
+
+uint64_t fnv1a(const void *data, size_t len, uint64_t h = 1469598103934665603ULL){
+    const uint8_t *p = static_cast<const uint8_t*>(data);
+    for(size_t i=0;i<len;++i){ h ^= p[i]; h *= 1099511628211ULL; }
+    return h;
+}
+
+uint64_t imageChecksum(const SnapshotImage &img, size_t end = CHECKSUM_END){
+    return fnv1a(reinterpret_cast<const uint8_t*>(&img) + CHECKSUM_BEGIN, end - CHECKSUM_BEGIN);
+}
+
+}
+
+uint64_t CPU::programHash(const vector<Instruction> &program){
+    uint64_t h = fnv1a(nullptr, 0);
+    for(auto &in : program){
+        // NUL separators keep ("AB","C") distinct from ("A","BC")
+        for(const string *f : {&in.label, &in.op, &in.arg1, &in.arg2})
+            h = fnv1a(f->c_str(), f->size() + 1, h);
+    }
+    return h;
+}
+
+void CPU::saveSnapshot(const string &path, const vector<Instruction> &program,
+                       size_t pc, size_t cycleCount) const {
+    SnapshotImage img{};
+    memcpy(img.magic, SNAPSHOT_MAGIC, sizeof(img.magic));
+    img.version = toLE(SNAPSHOT_VERSION);
+    img.programHash = toLE(programHash(program));
+    img.pc = toLE(static_cast<uint64_t>(pc));
+    img.cycleCount = toLE(static_cast<uint64_t>(cycleCount));
+    for(int i=0;i<9;++i) img.registers[i] = toLE(getRegister(SNAPSHOT_REGS[i]));
+    for(int i=0;i<4;++i) img.flags[i] = getFlag(SNAPSHOT_FLAGS[i]);
+    memcpy(img.memory, memory, sizeof(img.memory));
+    for(int i=0;i<8;++i) memcpy(img.vregisters[i], vregisters[i].bytes, 32);
+    img.scalarOps = toLE(scalarOps);
+    img.vectorOps = toLE(vectorOps);
+    img.checksum = toLE(imageChecksum(img));
+
+    // Write to a unique temp file next to path and rename it into place, so
+    // concurrent savers never share an inode and readers never map a
+    // half-written snapshot
+    string tmpl = path + ".XXXXXX";
+    vector<char> name(tmpl.begin(), tmpl.end());
+    name.push_back('\0');
+    int fd = ::mkstemp(name.data());
+    if(fd < 0) throw runtime_error("Cannot create snapshot: " + path);
+    // mkstemp's 0600 is kept on purpose: snapshots hold the full machine state,
+    // and changing the process umask to honour it is not thread-safe
+    string tmp(name.data());
+    if(::ftruncate(fd, sizeof(SnapshotImage)) != 0){
+        ::close(fd); ::unlink(tmp.c_str());
+        throw runtime_error("Cannot size snapshot: " + path);
+    }
+    void *map = ::mmap(nullptr, sizeof(SnapshotImage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(map == MAP_FAILED){
+        ::close(fd); ::unlink(tmp.c_str());
+        throw runtime_error("Cannot map snapshot: " + path);
+    }
+    memcpy(map, &img, sizeof(img));
+    bool synced = ::msync(map, sizeof(SnapshotImage), MS_SYNC) == 0;
+    ::munmap(map, sizeof(SnapshotImage));
+    synced = synced && ::fsync(fd) == 0;
+    ::close(fd);
+    if(!synced || ::rename(tmp.c_str(), path.c_str()) != 0){
+        ::unlink(tmp.c_str());
+        throw runtime_error("Cannot write snapshot: " + path);
+    }
+    // Make the rename itself durable
+    size_t slash = path.rfind('/');
+    string dir = (slash == string::npos) ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int dfd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    bool dirSynced = dfd >= 0 && ::fsync(dfd) == 0;
+    if(dfd >= 0) ::close(dfd);
+    if(!dirSynced) throw runtime_error("Cannot sync snapshot directory: " + dir);
+}
+
+void CPU::loadSnapshot(const string &path, const vector<Instruction> &program,
+                       size_t &pc, size_t &cycleCount){
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) throw runtime_error("Cannot open snapshot: " + path);
+    struct stat st;
+    if(::fstat(fd, &st) != 0 || (static_cast<size_t>(st.st_size) != sizeof(SnapshotImage)
+                                  && static_cast<size_t>(st.st_size) != V1_SIZE)){
+        ::close(fd);
+        throw runtime_error("Invalid snapshot size: " + path);
+    }
+    size_t size = st.st_size;
+    // Read-only private mapping: many workers can restore from one file concurrently
+    void *map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(map == MAP_FAILED) throw runtime_error("Cannot map snapshot: " + path);
+    // v1 files stop before the vector bank; it and the counters stay zero
+    SnapshotImage img{};
+    memcpy(&img, map, size == V1_SIZE ? V1_CHECKSUM_END : sizeof(img));
+    ::munmap(map, size);
+
+    if(memcmp(img.magic, SNAPSHOT_MAGIC, sizeof(img.magic)) != 0)
+        throw runtime_error("Not a snapshot file: " + path);
+    img.version = toLE(img.version);
+    size_t checksumEnd;
+    if(img.version == SNAPSHOT_VERSION && size == sizeof(SnapshotImage)) checksumEnd = CHECKSUM_END;
+    else if(img.version == 1 && size == V1_SIZE) checksumEnd = V1_CHECKSUM_END;
+    else throw runtime_error("Unsupported snapshot version: " + to_string(img.version));
+    if(toLE(img.checksum) != imageChecksum(img, checksumEnd))
+        throw runtime_error("Snapshot checksum mismatch: " + path);
+    img.programHash = toLE(img.programHash);
+    img.pc = toLE(img.pc);
+    img.cycleCount = toLE(img.cycleCount);
+    for(int i=0;i<9;++i) img.registers[i] = toLE(img.registers[i]);
+    img.scalarOps = toLE(img.scalarOps);
+    img.vectorOps = toLE(img.vectorOps);
+    if(img.programHash != programHash(program))
+        throw runtime_error("Snapshot was taken from a different program");
+    if(img.pc > program.size())
+        throw runtime_error("Snapshot pc out of range");
+
+    for(int i=0;i<9;++i) registers[SNAPSHOT_REGS[i]] = img.registers[i];
+    for(int i=0;i<4;++i) flags[SNAPSHOT_FLAGS[i]] = img.flags[i] != 0;
+    memcpy(memory, img.memory, sizeof(memory));
+    for(int i=0;i<8;++i) memcpy(vregisters[i].bytes, img.vregisters[i], 32);
+    scalarOps = img.scalarOps;
+    vectorOps = img.vectorOps;
+    buildLabelMap(program);
+    pc = img.pc;
+    cycleCount = img.cycleCount;
+}
+
 void CPU::displayState() const {
     cout << "Registers:\n";
     for (auto &r : registers) cout << r.first << "=" << r.second << "\n";
@@ -225,5 +639,10 @@ void CPU::displayState() const {
     for (auto &f : flags) cout << f.first << "=" << f.second << " ";
     cout << "\nMemory(16 bytes): ";
     for (int i = 0; i < 16; ++i) cout << (int)memory[i] << " ";
-    cout << "\n";
+    cout << "\nVector registers:\n";
+    for (int i = 0; i < 8; ++i) {
+        const VectorRegister &v = vregisters[i];
+        cout << "YMM" << i << "=" << hex << v.lane64(3) << ":" << v.lane64(2) << ":" << v.lane64(1) << ":" << v.lane64(0) << dec << "\n";
+    }
+    cout << "Ops: scalar=" << scalarOps << " vector=" << vectorOps << "\n";
 }
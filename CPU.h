@@ -21,6 +21,17 @@ struct Instruction {
         : label(l), op(o), arg1(a1), arg2(a2) {}
 };
 
+// 256-bit vector register (YMMn); XMMn names its low 128 bits
+struct VectorRegister {
+    alignas(32) uint8_t bytes[32];
+    // lanes are little-endian, as on the x86 guest, whatever the host is
+    uint64_t lane64(int i) const {
+        uint64_t v = 0;
+        for (int b = 7; b >= 0; --b) v = (v << 8) | bytes[8*i + b];
+        return v;
+    }
+};
+
 enum PipelineStage { FETCH, DECODE, EXECUTE, WRITEBACK };
 
 class CPU {
@@ -28,11 +39,19 @@ private:
     unordered_map<string,uint64_t> registers;
     unordered_map<string,bool> flags;
     uint8_t memory[256];
+    VectorRegister vregisters[8];
+
+    // executed instruction counts, scalar and vector kept apart
+    uint64_t scalarOps;
+    uint64_t vectorOps;
 
     // label -> program index
     map<string,size_t> labelMap;
 
     uint64_t strToValue(const string &s);
+    // Resolves XMMn/YMMn to a bank index and its width in bytes
+    size_t vectorIndex(const string &name, size_t &width) const;
+    size_t memOperand(const string &s, size_t width);
 
 public:
     CPU();
@@ -41,6 +60,9 @@ public:
     bool getFlag(const string &name) const;
     uint8_t getMemory(size_t addr) const;
     void setMemory(size_t addr,uint8_t value);
+    VectorRegister getVectorRegister(const string &name) const;
+    uint64_t getScalarOpCount() const { return scalarOps; }
+    uint64_t getVectorOpCount() const { return vectorOps; }
 
     // Basic arithmetic / data
     void MOV(const string &dest,const string &src);
@@ -57,6 +79,23 @@ public:
     void OR(const string &reg1, const string &reg2);
     void XOR(const string &reg1, const string &reg2);
 
+    // Packed integer vector operations (dest = dest op src, lane-wise).
+    // Both operands must be the same width (XMM or YMM). Writing an XMM
+    // register zeroes the upper half of its YMM register.
+    void VPADDD(const string &dest, const string &src);
+    void VPADDQ(const string &dest, const string &src);
+    void VPSUBD(const string &dest, const string &src);
+    void VPSUBQ(const string &dest, const string &src);
+    void VPAND(const string &dest, const string &src);
+    void VPOR(const string &dest, const string &src);
+    void VPXOR(const string &dest, const string &src);
+    void VPCMPEQD(const string &dest, const string &src); // all-ones lane where equal
+    void VPCMPEQQ(const string &dest, const string &src);
+    void VPBROADCASTD(const string &dest, const string &src); // scalar reg or immediate
+    void VPBROADCASTQ(const string &dest, const string &src);
+    // VMOVDQU YMM0 [RSI] loads, VMOVDQU [RSI] YMM0 stores, else reg -> reg
+    void VMOVDQU(const string &dest, const string &src);
+
     // Control flow
     void JMP(size_t addr,size_t &pc);
     void JE(size_t addr,size_t &pc);
@@ -68,6 +107,18 @@ public:
     // Build label map from program (label -> index)
     void buildLabelMap(const vector<Instruction> &program);
 
+    // Identity hash of a program (FNV-1a over labels, ops and args)
+    static uint64_t programHash(const vector<Instruction> &program);
+
+    // Snapshots: full state (registers, flags, memory, pc, cycle count) in a
+    // versioned, checksummed, memory-mapped file bound to one program.
+    // Loading throws if the file is corrupt or belongs to another program.
+    // Saved files are created owner-only (0600).
+    void saveSnapshot(const string &path, const vector<Instruction> &program,
+                      size_t pc, size_t cycleCount) const;
+    void loadSnapshot(const string &path, const vector<Instruction> &program,
+                      size_t &pc, size_t &cycleCount);
+
     void displayState() const;
 };
 
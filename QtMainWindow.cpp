@@ -5,14 +5,16 @@
 #include <QString>
 #include <QTimer>
 #include <QCoreApplication>
+#include <QFileDialog>
 #include <thread>
 #include <chrono>
 
-QtMainWindow::QtMainWindow(QWidget *parent) : QMainWindow(parent), pc(0), cycleCount(0) {
+QtMainWindow::QtMainWindow(QWidget *parent) : QMainWindow(parent), pc(0), cycleCount(0), inStep(false) {
     setupUI();
     loadProgram();
     cpu.buildLabelMap(program);
     updateRegistersGUI();
+    updateVectorGUI();
     updateFlagsGUI();
     updateMemoryGUI();
     updateStackGUI();
@@ -87,8 +89,27 @@ void QtMainWindow::setupUI() {
     }
     stackTable->setStyleSheet("QHeaderView::section { background-color: navy; color: white; }");
 
+    // Vector registers: YMM0..YMM7 as four 64-bit lanes, high to low
+    vectorTable = new QTableWidget(8,2,this);
+    vectorTable->setHorizontalHeaderLabels({"Vector","Lanes (3:2:1:0)"});
+    vectorTable->verticalHeader()->setVisible(false);
+    vectorTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    for(int i=0;i<8;i++){
+        QTableWidgetItem *regItem = new QTableWidgetItem("YMM" + QString::number(i));
+        regItem->setForeground(QBrush(Qt::white));
+        regItem->setBackground(QBrush(QColor(0,0,128)));
+        vectorTable->setItem(i,0,regItem);
+
+        QTableWidgetItem *valItem = new QTableWidgetItem("0");
+        valItem->setForeground(QBrush(Qt::white));
+        valItem->setBackground(QBrush(QColor(0,0,128)));
+        vectorTable->setItem(i,1,valItem);
+    }
+    vectorTable->setStyleSheet("QHeaderView::section { background-color: navy; color: white; }");
+
     midRow->addWidget(memoryTable,3);
     midRow->addWidget(stackTable,1);
+    midRow->addWidget(vectorTable,2);
 
     // Flags and pipeline
     flagsLabel = new QLabel("ZF=0 CF=0 SF=0 OF=0", this);
@@ -97,6 +118,9 @@ void QtMainWindow::setupUI() {
     pipelineLabel = new QLabel("Pipeline Stage: FETCH", this);
     pipelineLabel->setStyleSheet("QLabel { color: black; font-weight:bold; font-size:14px; }");
 
+    opsLabel = new QLabel("Ops: scalar=0 vector=0", this);
+    opsLabel->setStyleSheet("QLabel { color: black; font-weight:bold; font-size:14px; }");
+
     cycleBar = new QProgressBar(this);
     cycleBar->setRange(0,1000);
     cycleBar->setValue(0);
@@ -105,17 +129,22 @@ void QtMainWindow::setupUI() {
     stepButton = new QPushButton("Step", this);
     runButton = new QPushButton("Run", this);
     resetButton = new QPushButton("Reset", this);
+    saveButton = new QPushButton("Save", this);
+    loadButton = new QPushButton("Load", this);
 
     QHBoxLayout *buttonLayout = new QHBoxLayout();
     buttonLayout->addWidget(stepButton);
     buttonLayout->addWidget(runButton);
     buttonLayout->addWidget(resetButton);
+    buttonLayout->addWidget(saveButton);
+    buttonLayout->addWidget(loadButton);
     buttonLayout->addWidget(cycleBar);
 
     mainLayout->addLayout(topRow);
     mainLayout->addLayout(midRow);
     mainLayout->addWidget(flagsLabel);
     mainLayout->addWidget(pipelineLabel);
+    mainLayout->addWidget(opsLabel);
     mainLayout->addLayout(buttonLayout);
 
     setCentralWidget(central);
@@ -124,6 +153,8 @@ void QtMainWindow::setupUI() {
     connect(stepButton, &QPushButton::clicked, this, &QtMainWindow::stepInstruction);
     connect(runButton, &QPushButton::clicked, this, &QtMainWindow::runProgram);
     connect(resetButton, &QPushButton::clicked, this, &QtMainWindow::resetProgram);
+    connect(saveButton, &QPushButton::clicked, this, &QtMainWindow::saveSnapshot);
+    connect(loadButton, &QPushButton::clicked, this, &QtMainWindow::loadSnapshot);
 }
 
 void QtMainWindow::loadProgram(){
@@ -179,6 +210,18 @@ void QtMainWindow::updateRegistersGUI(){
     registersTable->item(8,1)->setText(QString::number(pc)); // RIP
 }
 
+void QtMainWindow::updateVectorGUI(){
+    for(int i=0;i<8;++i){
+        VectorRegister v = cpu.getVectorRegister("YMM" + to_string(i));
+        QString text;
+        for(int l=3;l>=0;--l){
+            text += QString("%1").arg(v.lane64(l), 16, 16, QChar('0'));
+            if(l) text += ":";
+        }
+        vectorTable->item(i,1)->setText(text);
+    }
+}
+
 void QtMainWindow::updateFlagsGUI(){
     QString text;
     vector<string> fs = {"ZF","CF","SF","OF"};
@@ -219,6 +262,8 @@ void QtMainWindow::updatePipelineGUI(PipelineStage stage){
     case WRITEBACK: stageName="WRITEBACK"; break;
     }
     pipelineLabel->setText("Pipeline Stage: " + stageName);
+    opsLabel->setText(QString("Ops: scalar=%1 vector=%2")
+                          .arg(cpu.getScalarOpCount()).arg(cpu.getVectorOpCount()));
     cycleBar->setValue(static_cast<int>(cycleCount % 1000));
 }
 
@@ -249,24 +294,45 @@ void QtMainWindow::highlightInstruction(PipelineStage stage){
     }
 }
 
+void QtMainWindow::setControlsEnabled(bool enabled){
+    stepButton->setEnabled(enabled);
+    runButton->setEnabled(enabled);
+    resetButton->setEnabled(enabled);
+    saveButton->setEnabled(enabled);
+    loadButton->setEnabled(enabled);
+}
+
 void QtMainWindow::stepInstruction(){
-    if(pc >= program.size()) return;
+    if(inStep || pc >= program.size()) return;
+
+    // processEvents() between stages lets clicks through; keep them from
+    // replacing or saving the CPU state until the instruction has finished
+    inStep = true;
+    setControlsEnabled(false);
+    runPipelineStages();
+    setControlsEnabled(true);
+    inStep = false;
+}
 
+void QtMainWindow::runPipelineStages(){
     updatePipelineGUI(FETCH);
     highlightInstruction(FETCH);
     QCoreApplication::processEvents();
+    if(pc >= program.size()) return;
     std::this_thread::sleep_for(std::chrono::milliseconds(150));
     cycleCount++;
 
     updatePipelineGUI(DECODE);
     highlightInstruction(DECODE);
     QCoreApplication::processEvents();
+    if(pc >= program.size()) return;
     std::this_thread::sleep_for(std::chrono::milliseconds(150));
     cycleCount++;
 
     updatePipelineGUI(EXECUTE);
     highlightInstruction(EXECUTE);
     QCoreApplication::processEvents();
+    if(pc >= program.size()) return;
     try{
         cpu.execute(program[pc], pc);
     } catch(const std::exception &e){
@@ -274,6 +340,7 @@ void QtMainWindow::stepInstruction(){
         return;
     }
     updateRegistersGUI();
+    updateVectorGUI();
     updateFlagsGUI();
     updateMemoryGUI();
     updateStackGUI();
@@ -289,24 +356,58 @@ void QtMainWindow::stepInstruction(){
     updatePipelineGUI(FETCH);
     highlightInstruction(FETCH);
     updateRegistersGUI();
+    updateVectorGUI();
     updateFlagsGUI();
     updateMemoryGUI();
     updateStackGUI();
 }
 
 void QtMainWindow::runProgram(){
+    if(inStep) return;
     while(pc < program.size()){
         stepInstruction();
     }
 }
 
 void QtMainWindow::resetProgram(){
+    if(inStep) return;
     cpu = CPU();
     loadProgram();
     cpu.buildLabelMap(program);
     pc = 0;
     cycleCount = 0;
     updateRegistersGUI();
+    updateVectorGUI();
+    updateFlagsGUI();
+    updateMemoryGUI();
+    updateStackGUI();
+    updatePipelineGUI(FETCH);
+    highlightInstruction(FETCH);
+}
+
+void QtMainWindow::saveSnapshot(){
+    if(inStep) return;
+    QString path = QFileDialog::getSaveFileName(this, "Save Snapshot", "", "CPU Snapshots (*.snap)");
+    if(path.isEmpty()) return;
+    try{
+        cpu.saveSnapshot(path.toStdString(), program, pc, cycleCount);
+    } catch(const std::exception &e){
+        setWindowTitle("Snapshot error: " + QString::fromStdString(e.what()));
+    }
+}
+
+void QtMainWindow::loadSnapshot(){
+    if(inStep) return;
+    QString path = QFileDialog::getOpenFileName(this, "Load Snapshot", "", "CPU Snapshots (*.snap)");
+    if(path.isEmpty()) return;
+    try{
+        cpu.loadSnapshot(path.toStdString(), program, pc, cycleCount);
+    } catch(const std::exception &e){
+        setWindowTitle("Snapshot error: " + QString::fromStdString(e.what()));
+        return;
+    }
+    updateRegistersGUI();
+    updateVectorGUI();
     updateFlagsGUI();
     updateMemoryGUI();
     updateStackGUI();
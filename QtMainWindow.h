@@ -23,34 +23,44 @@ private:
 
     // UI elements
     QTableWidget *registersTable;
+    QTableWidget *vectorTable;
     QTableWidget *memoryTable;
     QLabel *flagsLabel;
     QTableWidget *instructionsTable;
     QTableWidget *stackTable;
     QLabel *pipelineLabel;
+    QLabel *opsLabel;
     QProgressBar *cycleBar;
 
     QPushButton *stepButton;
     QPushButton *runButton;
     QPushButton *resetButton;
+    QPushButton *saveButton;
+    QPushButton *loadButton;
 
     vector<Instruction> program;
     size_t pc;
     size_t cycleCount;
+    bool inStep; // an instruction is partway through the pipeline
 
     void setupUI();
     void loadProgram();
     void updateRegistersGUI();
+    void updateVectorGUI();
     void updateFlagsGUI();
     void updateMemoryGUI();
     void updateStackGUI();
     void updatePipelineGUI(PipelineStage stage);
     void highlightInstruction(PipelineStage stage);
+    void setControlsEnabled(bool enabled);
+    void runPipelineStages();
 
 private slots:
     void stepInstruction();
     void runProgram();
     void resetProgram();
+    void saveSnapshot();
+    void loadSnapshot();
 };
 
 #endif // QTMAINWINDOW_H
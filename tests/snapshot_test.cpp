@@ -0,0 +1,201 @@
+// Snapshot restore check: interrupt the demo program at every pc, resume from
+// the saved file in a fresh CPU and compare against an uninterrupted run.
+#include "CPU.h"
+#include <cstdio>
+#include <cstring>
+
+static int failures = 0;
+#define CHECK(cond) do { if(!(cond)) { cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed\n"; failures++; } } while(0)
+
+static const char *SNAP = "snapshot_test.snap";
+static const char *REGS[] = {"RAX","RBX","RCX","RDX","RSI","RDI","RSP","RBP","RIP"};
+static const char *FLAGS[] = {"ZF","CF","SF","OF"};
+
+// Same sequence as QtMainWindow::loadProgram
+static vector<Instruction> demoProgram(){
+    return {
+        Instruction("start","MOV","RAX","5"),
+        Instruction("","MOV","RBX","3"),
+        Instruction("","MUL","RAX","RBX"),
+        Instruction("","INC","RAX",""),
+        Instruction("","CMP","RAX","16"),
+        Instruction("","JE","equal",""),
+        Instruction("","DEC","RAX",""),
+        Instruction("","DIV","RBX",""),
+        Instruction("","AND","RAX","RBX"),
+        Instruction("","OR","RCX","RAX"),
+        Instruction("","XOR","RDX","RBX"),
+        Instruction("equal","MOV","RCX","999")
+    };
+}
+
+// Fills all eight vector registers with distinct lanes, so a snapshot that
+// drops, reorders or truncates the vector bank cannot resume correctly. The
+// XMM write clears YMM6's upper half partway through.
+static vector<Instruction> vectorProgram(){
+    return {
+        Instruction("start","MOV","RSI","0x10"),
+        Instruction("","VMOVDQU","YMM0","[RSI]"),
+        Instruction("","VPBROADCASTQ","YMM1","0x0102030405060708"),
+        Instruction("","VPADDD","YMM0","YMM1"),
+        Instruction("","VPBROADCASTD","YMM2","RSI"),
+        Instruction("","VMOVDQU","YMM3","YMM0"),
+        Instruction("","VPXOR","YMM3","YMM2"),
+        Instruction("","VMOVDQU","YMM4","[0x40]"),
+        Instruction("","VPBROADCASTQ","YMM5","0xDEADBEEF"),
+        Instruction("","VPCMPEQD","YMM6","YMM6"),
+        Instruction("","VMOVDQU","YMM7","YMM4"),
+        Instruction("","VPSUBQ","YMM7","YMM6"),
+        Instruction("","VPSUBQ","XMM6","XMM1"),
+        Instruction("","MOV","RDI","0xA0"),
+        Instruction("","VMOVDQU","[RDI]","YMM0"),
+        Instruction("","INC","RCX",""),
+        Instruction("","CMP","RCX","2"),
+        Instruction("","JNE","start",""),
+        Instruction("","VPADDQ","YMM7","YMM3")
+    };
+}
+
+// One step as the window takes it: four pipeline cycles per instruction
+static void step(CPU &cpu, const vector<Instruction> &program, size_t &pc, size_t &cycleCount){
+    cpu.execute(program[pc], pc);
+    cycleCount += 4;
+}
+
+static void checkSameState(const CPU &a, size_t pcA, size_t cycA, const CPU &b, size_t pcB, size_t cycB){
+    CHECK(pcA == pcB);
+    CHECK(cycA == cycB);
+    for(auto r : REGS) CHECK(a.getRegister(r) == b.getRegister(r));
+    for(auto f : FLAGS) CHECK(a.getFlag(f) == b.getFlag(f));
+    for(size_t i=0;i<256;++i) CHECK(a.getMemory(i) == b.getMemory(i));
+    for(int i=0;i<8;++i){
+        string name = "YMM" + to_string(i);
+        CHECK(memcmp(a.getVectorRegister(name).bytes, b.getVectorRegister(name).bytes, 32) == 0);
+    }
+    CHECK(a.getScalarOpCount() == b.getScalarOpCount());
+    CHECK(a.getVectorOpCount() == b.getVectorOpCount());
+}
+
+// Rewrites a v2 snapshot as the v1 layout: the v2 prefix up to the vector
+// bank (380 bytes) padded to 384, version 1, checksum over bytes 32..380
+static void downgradeToV1(const char *path){
+    FILE *f = fopen(path, "rb");
+    uint8_t buf[656] = {0};
+    size_t n = f ? fread(buf, 1, sizeof(buf), f) : 0;
+    if(f) fclose(f);
+    CHECK(n == sizeof(buf));
+    memset(buf + 380, 0, 4);
+    buf[8] = 1; buf[9] = buf[10] = buf[11] = 0;     // version, little-endian
+    uint64_t h = 1469598103934665603ULL;
+    for(size_t i=32;i<380;++i){ h ^= buf[i]; h *= 1099511628211ULL; }
+    for(int i=0;i<8;++i) buf[24 + i] = static_cast<uint8_t>(h >> (8*i));
+    f = fopen(path, "wb");
+    if(f){ fwrite(buf, 1, 384, f); fclose(f); }
+}
+
+// Interrupt after every k steps, resume from the file in a fresh CPU and
+// compare with the uninterrupted run
+static void checkResumeAtEveryStep(const vector<Instruction> &program, const CPU &initial,
+                                   const CPU &reference, size_t refPc, size_t refCycles){
+    size_t steps = 0;
+    {
+        CPU cpu = initial;
+        size_t pc = 0, cycleCount = 0;
+        while(pc < program.size()){ step(cpu, program, pc, cycleCount); steps++; }
+    }
+    for(size_t k=0;k<=steps;++k){
+        CPU first = initial;
+        size_t pc = 0, cycleCount = 0;
+        for(size_t i=0;i<k;++i) step(first, program, pc, cycleCount);
+        first.saveSnapshot(SNAP, program, pc, cycleCount);
+
+        CPU resumed;
+        size_t pc2 = 0, cycles2 = 0;
+        resumed.loadSnapshot(SNAP, program, pc2, cycles2);
+        checkSameState(first, pc, cycleCount, resumed, pc2, cycles2);
+        while(pc2 < program.size()) step(resumed, program, pc2, cycles2);
+        checkSameState(reference, refPc, refCycles, resumed, pc2, cycles2);
+    }
+}
+
+static bool throwsOnLoad(const vector<Instruction> &program){
+    CPU cpu;
+    size_t pc = 0, cycleCount = 0;
+    try { cpu.loadSnapshot(SNAP, program, pc, cycleCount); }
+    catch(const runtime_error &) { return true; }
+    return false;
+}
+
+int main(){
+    vector<Instruction> program = demoProgram();
+
+    CPU reference;
+    reference.buildLabelMap(program);
+    for(size_t i=0;i<256;++i) reference.setMemory(i, static_cast<uint8_t>(i * 7));
+    CPU initial = reference;
+    size_t refPc = 0, refCycles = 0;
+    while(refPc < program.size()) step(reference, program, refPc, refCycles);
+    checkResumeAtEveryStep(program, initial, reference, refPc, refCycles);
+
+    // Same check with live vector state at every save point
+    {
+        vector<Instruction> vprogram = vectorProgram();
+        CPU vreference;
+        vreference.buildLabelMap(vprogram);
+        for(size_t i=0;i<256;++i) vreference.setMemory(i, static_cast<uint8_t>(i * 13 + 5));
+        CPU vinitial = vreference;
+        size_t vPc = 0, vCycles = 0;
+        while(vPc < vprogram.size()) step(vreference, vprogram, vPc, vCycles);
+        CHECK(vreference.getVectorOpCount() == 27);
+        CHECK(vreference.getVectorRegister("YMM6").bytes[16] == 0);
+        CHECK(vreference.getVectorRegister("YMM6").bytes[0] != 0);
+        checkResumeAtEveryStep(vprogram, vinitial, vreference, vPc, vCycles);
+    }
+
+    // v1 files (no vector bank or counters) still load, with those zeroed
+    {
+        CPU first = initial;
+        size_t pc = 0, cycleCount = 0;
+        for(int i=0;i<3;++i) step(first, program, pc, cycleCount);
+        first.saveSnapshot(SNAP, program, pc, cycleCount);
+        downgradeToV1(SNAP);
+
+        CPU resumed;
+        size_t pc2 = 0, cycles2 = 0;
+        resumed.loadSnapshot(SNAP, program, pc2, cycles2);
+        CHECK(pc2 == pc && cycles2 == cycleCount);
+        for(auto r : REGS) CHECK(resumed.getRegister(r) == first.getRegister(r));
+        for(size_t i=0;i<256;++i) CHECK(resumed.getMemory(i) == first.getMemory(i));
+        CHECK(resumed.getScalarOpCount() == 0);
+        for(int i=0;i<32;++i) CHECK(resumed.getVectorRegister("YMM0").bytes[i] == 0);
+        while(pc2 < program.size()) step(resumed, program, pc2, cycles2);
+        for(auto r : REGS) CHECK(resumed.getRegister(r) == reference.getRegister(r));
+        for(auto f : FLAGS) CHECK(resumed.getFlag(f) == reference.getFlag(f));
+    }
+
+    // Re-save as v2 for the rejection checks below
+    reference.saveSnapshot(SNAP, program, refPc, refCycles);
+
+    // A different program must be rejected by the identity hash
+    vector<Instruction> other = program;
+    other[0].arg2 = "6";
+    CHECK(throwsOnLoad(other));
+    CHECK(!throwsOnLoad(program));
+
+    // A single flipped byte must be rejected by the checksum
+    FILE *f = fopen(SNAP, "r+b");
+    CHECK(f != nullptr);
+    if(f){
+        fseek(f, 200, SEEK_SET);
+        int c = fgetc(f);
+        fseek(f, 200, SEEK_SET);
+        fputc(c ^ 0x01, f);
+        fclose(f);
+    }
+    CHECK(throwsOnLoad(program));
+
+    remove(SNAP);
+    if(failures) cerr << failures << " check(s) failed\n";
+    else cout << "snapshot_test passed\n";
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,139 @@
+// Vector instruction check. CMake builds this file four times so each
+// vecKernel path runs: default (AVX2 when the host has it, else SSE2),
+// SSE2 without SSE4.1 and with AVX2 dispatch off (emulated 64-bit compare),
+// SSE4.1 with AVX2 dispatch off (_mm_cmpeq_epi64), and -mno-sse2 (scalar).
+#include "CPU.h"
+
+static int failures = 0;
+#define CHECK(cond) do { if(!(cond)) { cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed\n"; failures++; } } while(0)
+
+static uint64_t lane64(const CPU &cpu, const string &reg, int i){
+    return cpu.getVectorRegister(reg).lane64(i);
+}
+static uint32_t lane32(const CPU &cpu, const string &reg, int i){
+    uint64_t v = lane64(cpu, reg, i / 2);
+    return static_cast<uint32_t>(i % 2 ? v >> 32 : v);
+}
+
+// Fixed inputs, loaded from memory: A at 0x00, B at 0x20
+static const uint64_t A[4] = {0xFFFFFFFF00000001ULL, 0x0000000100000000ULL, 0x8000000000000000ULL, 0x1234567890ABCDEFULL};
+static const uint64_t B[4] = {0x00000001FFFFFFFFULL, 0x0000000200000000ULL, 0x8000000000000000ULL, 0x12345678FFFFFFFFULL};
+
+// YMM0 = A, YMM1 = B (all 32 bytes, so XMM upper-half zeroing is observable)
+static void loadInputs(CPU &cpu){
+    for(int i=0;i<4;++i)
+        for(int k=0;k<8;++k){
+            cpu.setMemory(8*i + k, static_cast<uint8_t>(A[i] >> (8*k)));
+            cpu.setMemory(0x20 + 8*i + k, static_cast<uint8_t>(B[i] >> (8*k)));
+        }
+    cpu.VMOVDQU("YMM0", "[0]");
+    cpu.VMOVDQU("YMM1", "[0x20]");
+}
+
+static uint32_t lo(uint64_t v){ return static_cast<uint32_t>(v); }
+static uint32_t hi(uint64_t v){ return static_cast<uint32_t>(v >> 32); }
+
+// Runs one binary op at both widths and checks every lane
+template<class F64>
+static void checkOp64(const string &op, F64 expect){
+    for(int ymm=0;ymm<2;++ymm){
+        CPU cpu;
+        string a = ymm ? "YMM0" : "XMM0", b = ymm ? "YMM1" : "XMM1";
+        loadInputs(cpu);
+        vector<Instruction> program = {Instruction("", op, a, b)};
+        size_t pc = 0;
+        cpu.execute(program[0], pc);
+        int lanes = ymm ? 4 : 2;
+        for(int i=0;i<lanes;++i){
+            if(lane64(cpu, "YMM0", i) != expect(A[i], B[i])){
+                cerr << op << " " << a << " lane " << i << " wrong\n";
+                failures++;
+            }
+        }
+        for(int i=lanes;i<4;++i) CHECK(lane64(cpu, "YMM0", i) == 0);
+        CHECK(cpu.getVectorOpCount() == 1);
+    }
+}
+
+static uint64_t join(uint32_t h, uint32_t l){ return (static_cast<uint64_t>(h) << 32) | l; }
+
+int main(){
+#if defined(__AVX2__) || !defined(CPU_VISUALIZER_NO_AVX2) && defined(__SSE2__)
+    cout << "vector_test: AVX2 dispatch / SSE2 build\n";
+#elif defined(__SSE4_1__)
+    cout << "vector_test: SSE4.1 build, no AVX2 dispatch\n";
+#elif defined(__SSE2__)
+    cout << "vector_test: SSE2 build, no AVX2 dispatch\n";
+#else
+    cout << "vector_test: scalar build\n";
+#endif
+
+    checkOp64("VPADDQ", [](uint64_t a, uint64_t b){ return a + b; });
+    checkOp64("VPSUBQ", [](uint64_t a, uint64_t b){ return a - b; });
+    checkOp64("VPADDD", [](uint64_t a, uint64_t b){ return join(hi(a) + hi(b), lo(a) + lo(b)); });
+    checkOp64("VPSUBD", [](uint64_t a, uint64_t b){ return join(hi(a) - hi(b), lo(a) - lo(b)); });
+    checkOp64("VPAND", [](uint64_t a, uint64_t b){ return a & b; });
+    checkOp64("VPOR", [](uint64_t a, uint64_t b){ return a | b; });
+    checkOp64("VPXOR", [](uint64_t a, uint64_t b){ return a ^ b; });
+    checkOp64("VPCMPEQD", [](uint64_t a, uint64_t b){
+        return join(hi(a) == hi(b) ? ~0U : 0, lo(a) == lo(b) ? ~0U : 0); });
+    // lane 3 has equal high dwords only: the emulated compare must give 0
+    checkOp64("VPCMPEQQ", [](uint64_t a, uint64_t b){ return a == b ? ~0ULL : 0; });
+
+    // Literal spot checks so the reference lambdas can't hide a shared mistake
+    {
+        CPU cpu;
+        loadInputs(cpu);
+        cpu.VPADDD("YMM0", "YMM1");
+        CHECK(lane32(cpu, "YMM0", 0) == 0 && lane32(cpu, "YMM0", 1) == 0); // no carry between dwords
+        CHECK(lane64(cpu, "YMM0", 2) == 0);
+        loadInputs(cpu);
+        cpu.VPCMPEQQ("YMM0", "YMM1");
+        CHECK(lane64(cpu, "YMM0", 0) == 0 && lane64(cpu, "YMM0", 2) == ~0ULL && lane64(cpu, "YMM0", 3) == 0);
+    }
+
+    // Broadcasts: immediate and scalar register, XMM clears the upper half
+    {
+        CPU cpu;
+        cpu.VPBROADCASTD("YMM2", "0x1122334455667788");
+        for(int i=0;i<8;++i) CHECK(lane32(cpu, "YMM2", i) == 0x55667788U);
+        cpu.MOV("RAX", "0x0102030405060708");
+        cpu.VPBROADCASTQ("XMM2", "RAX");
+        CHECK(lane64(cpu, "YMM2", 0) == 0x0102030405060708ULL && lane64(cpu, "YMM2", 1) == 0x0102030405060708ULL);
+        CHECK(lane64(cpu, "YMM2", 2) == 0 && lane64(cpu, "YMM2", 3) == 0);
+        CHECK(lane64(cpu, "XMM2", 2) == 0); // XMM view hides the upper half
+    }
+
+    // Load/store, register moves and the memOperand bounds check
+    {
+        CPU cpu;
+        loadInputs(cpu);
+        cpu.MOV("RDI", "0x80");
+        cpu.VMOVDQU("[RDI]", "YMM0");
+        for(int i=0;i<32;++i) CHECK(cpu.getMemory(0x80 + i) == cpu.getMemory(i));
+        cpu.VMOVDQU("[0xF0]", "XMM1");                     // last 16 bytes: fits
+        CHECK(cpu.getMemory(0xFF) == static_cast<uint8_t>(B[1] >> 56));
+        bool threw = false;
+        try { cpu.VMOVDQU("YMM3", "[0xF0]"); } catch(const out_of_range &) { threw = true; }
+        CHECK(threw);
+        threw = false;
+        try { cpu.VMOVDQU("[0xF0]", "YMM3"); } catch(const out_of_range &) { threw = true; }
+        CHECK(threw);
+        cpu.VMOVDQU("XMM4", "XMM0");
+        CHECK(lane64(cpu, "YMM4", 1) == A[1] && lane64(cpu, "YMM4", 2) == 0);
+    }
+
+    // Mixed XMM/YMM operands are rejected
+    {
+        CPU cpu;
+        int thrown = 0;
+        try { cpu.VPADDD("YMM0", "XMM1"); } catch(const out_of_range &) { thrown++; }
+        try { cpu.VPXOR("XMM0", "YMM1"); } catch(const out_of_range &) { thrown++; }
+        try { cpu.VMOVDQU("YMM0", "XMM1"); } catch(const out_of_range &) { thrown++; }
+        CHECK(thrown == 3);
+    }
+
+    if(failures) cerr << failures << " check(s) failed\n";
+    else cout << "vector_test passed\n";
+    return failures ? 1 : 0;
+}